@@ -13,6 +13,8 @@
 /* extra library I deemed useful to include */
 #include <ctype.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
 
 #define STAGE_NUM_ONE 1						  /* stage numbers */
 #define STAGE_NUM_TWO 2
@@ -24,6 +26,7 @@
 #define MAX_HASHTAG 10 						  /* The data contain up to 10 hashtags per user */
 #define MAX_USER 50 						  /* The dataset contain maximum 50 users */
 #define MAX_LEN 20 							  /* The max number of letters per hashtag is 20*/
+#define TOP_K_ARG 1 						  /* argv index of the optional k for stage 3 */
 
 typedef struct {
 	/* add your user_t struct definition */
@@ -37,6 +40,10 @@ typedef struct {
 	int hashtag_count; // number of hashtags to be derived from hashtags
 
 	int cfriend_count; // number of close friends (added for stage 4)
+
+	int *cfriend_nums; // close friends in ascending order (added for stage 4)
+
+	int cfriend_capacity; // allocated length of cfriend_nums
 	
 	int is_core; // status as core user
 
@@ -67,6 +74,29 @@ typedef struct {
 	list_t *unique_hashtags;
 } community_t;
 
+/* one candidate connection kept for the top-k mode of stage 3 */
+typedef struct {
+	int user_num;
+	double soc;
+} neighbour_t;
+
+/* bounded min-heap, the weakest kept connection sits at the root */
+typedef struct {
+	neighbour_t *items;
+	int size;
+	int capacity;
+} heap_t;
+
+/* rows of the friendship matrix handed from the reader thread to the
+   thread computing the strengths of connection */
+typedef struct {
+	int **matrix;
+	int *user_count;
+	int rows_ready; // number of rows fully read so far
+	pthread_mutex_t lock;
+	pthread_cond_t row_read;
+} row_queue_t;
+
 /****************************************************************/
 
 /* function prototypes */
@@ -79,15 +109,16 @@ void print_stage_header(int stage_num);
 
 void stage_one(user_t *users, int *user_count, int *max_hashtag_user_idx);
 void stage_two(user_t *users, int *user_count, int **matrix);
-void stage_three(user_t *users, int **friendship_m, int *user_count, double **soc_matrix);
-void stage_four(user_t *users, double *ths, int *thc, double **soc_matrix, int *user_count);
+void stage_three(int *user_count, double **soc_matrix, heap_t *heaps);
+void stage_four(user_t *users, int *thc, int *user_count);
 
 /* add your own function prototypes here */
 void read_users(user_t *users, int *user_count);
 void most_hash_user(user_t *users, int *user_count, int *max_hashtag_user_idx);
-int** create_matrix(int *user_count);
+int** create_matrix(user_t *users, int *user_count, double **soc_matrix);
+void *read_rows(void *arg);
 double s_o_c(int u1[], int u2[], int u1_num, int u2_num, int *user_count);
-double** create_soc_matrix(int **friendship_m, int *user_count);
+double** create_soc_matrix(int *user_count);
 void free_users(user_t *users, int *user_count);
 void free_matrix(int **matrix, int *user_num);
 void free_double_matrix(double **soc_matrix, int *user_count);
@@ -95,10 +126,26 @@ void print_double_matrix(double **soc_matrix, int *user_count);
 void free_communities(community_t *communities, int *core_users_count);
 int is_core(user_t user, int *thc);
 void fill_unique_hashtags(user_t *users, community_t *communities, int *core_users_count);
-void fill_close_friends(community_t *communities, user_t *users, int *core_users_count,
-double **soc_matrix, double *ths, int *user_count);
+void fill_close_friends(community_t *communities, user_t *users, int *core_users_count);
 void stage_4_output(community_t *communities, int *core_users_count, user_t *users);
-void count_close_friends(user_t *users, double **soc_matrix, int *user_count, double *ths);
+void find_connections(user_t *users, int **friendship_m, double **soc_matrix,
+heap_t *heaps, double *ths, int *user_count);
+void add_close_friend(user_t *user, int friend_num, int *user_count);
+double soc_bound(int deg1, int deg2);
+void process_row(user_t *users, int **friendship_m, int row, int *user_count,
+double **soc_matrix);
+int count_degree(int friends[], int *user_count);
+void add_pair_top_k(user_t *users, heap_t *heaps, int i, int j, double soc);
+void print_top_k(heap_t *heaps, int *user_count);
+int parse_top_k(char *arg, char *prog_name);
+
+heap_t *make_heaps(int *user_count, int *top_k);
+void free_heaps(heap_t *heaps, int *user_count);
+int is_weaker(neighbour_t a, neighbour_t b);
+int can_enter_heap(heap_t *heap, double soc);
+void heap_push(heap_t *heap, neighbour_t value);
+void heap_sift_down(heap_t *heap);
+neighbour_t heap_pop(heap_t *heap);
 
 /****************************************************************/
 
@@ -110,27 +157,52 @@ main(int argc, char *argv[]) {
 	int max_hashtag_user_idx = 0;
 	double ths;
 	int thc;
+	int top_k = 0; // 0 keeps the full U x U output of stage 3
 	assert(users);
+	if (argc > TOP_K_ARG) {
+		top_k = parse_top_k(argv[TOP_K_ARG], argv[0]);
+	}
 	/* stage 1: read user profiles */
 	stage_one(users, &user_count, &max_hashtag_user_idx); 
+	if (top_k > user_count - 1) {
+		/* no user has more connections than that, but keep heaps non-empty */
+		top_k = user_count > 1 ? user_count - 1 : 1;
+	}
 	
-	/* calculate the soc between u0 and u1 */
-	int **matrix = create_matrix(&user_count);
+	/* read the matrix. for the full stage 3 output, the strengths of each
+	   row are computed while the following rows are still being read */
+	double **soc_matrix = NULL;
+	heap_t *heaps = NULL;
+	if (top_k > 0) {
+		heaps = make_heaps(&user_count, &top_k);
+	} else {
+		soc_matrix = create_soc_matrix(&user_count);
+	}
+	int **matrix = create_matrix(users, &user_count, soc_matrix);
+
+	/* the stage 4 thresholds follow the matrix in the input. reading them
+	   now lets the top-k mode compute each pair once for stages 3 and 4 */
+	scanf("%lf %d", &ths, &thc);
+	find_connections(users, matrix, soc_matrix, heaps, &ths, &user_count);
+
+	/* stage 2: print the soc between u0 and u1 */
 	stage_two(users, &user_count, matrix);
 
-	/* stage 3: compute the strength of connection for all user pairs */
-	double **soc_matrix = create_soc_matrix(matrix, &user_count);
-	stage_three(users, matrix, &user_count, soc_matrix);
-	
+	/* stage 3: print the strength of connection for all user pairs */
+	stage_three(&user_count, soc_matrix, heaps);
+	if (top_k > 0) {
+		free_heaps(heaps, &user_count);
+	}
 
 	/* stage 4: detect communities and topics of interest */
-	scanf("%lf %d", &ths, &thc);
-	stage_four(users, &ths, &thc, soc_matrix, &user_count);
+	stage_four(users, &thc, &user_count);
 
 	/* free memories */
 	free_users(users, &user_count);
 	free_matrix(matrix, &user_count);
-	free_double_matrix(soc_matrix, &user_count);
+	if (soc_matrix != NULL) {
+		free_double_matrix(soc_matrix, &user_count);
+	}
 	
 	/* all done; take some rest */
 	return 0;
@@ -174,35 +246,30 @@ stage_two(user_t *users, int *user_count, int **matrix) {
 	printf("\n\n");
 }
 
-/* stage 3: compute the strength of connection for all user pairs */
+/* stage 3: print the strength of connection for all user pairs, or only
+   each user's k strongest connections when heaps are given. both were
+   already filled in by create_matrix() and find_connections()
+*/
 void 
-stage_three(user_t *users, int **friendship_m, int *user_count, double **soc_matrix) {
+stage_three(int *user_count, double **soc_matrix, heap_t *heaps) {
 	/* print stage header */
 	print_stage_header(STAGE_NUM_THREE);
-	for(int i = 0; i < *user_count - 1; i++) {
-		for(int j = i + 1; j < *user_count; j++) {
-			soc_matrix[i][j] = s_o_c(friendship_m[i], friendship_m[j], 
-			users[i].user_num, users[j].user_num, user_count);
-
-			soc_matrix[j][i] = soc_matrix[i][j]; // property of symetrix matrix
-			
-		}
+	if (heaps != NULL) {
+		print_top_k(heaps, user_count);
+	} else {
+		print_double_matrix(soc_matrix, user_count);
 	}
-
-	print_double_matrix(soc_matrix, user_count);
 	printf("\n");
 }
 
-/* stage 4: detect communities and topics of interest */
+/* stage 4: detect communities and topics of interest, from the close
+   friends found by find_connections() */
 void 
-stage_four(user_t *users, double *ths, int *thc, 
-double **soc_matrix, int *user_count) {
+stage_four(user_t *users, int *thc, int *user_count) {
 	/* print stage header */
 	print_stage_header(STAGE_NUM_FOUR);
 	
 	int core_users_count = 0;
-	count_close_friends(users, soc_matrix, 
-	user_count, ths);
 
 	/* update core users status */
 	for(int i = 0; i < *user_count; i++) {
@@ -225,8 +292,7 @@ double **soc_matrix, int *user_count) {
 		} 
 	}
 
-	fill_close_friends(communities, users, &core_users_count, 
-	soc_matrix, ths, user_count);
+	fill_close_friends(communities, users, &core_users_count);
 	fill_unique_hashtags(users, communities, &core_users_count);
 	stage_4_output(communities, &core_users_count, users);
 
@@ -251,6 +317,7 @@ read_users(user_t *users, int *user_count) {
 		getchar(); // eat the space
 		j = 0; // reset j for next user
 		users[i].hashtag_count = 0; // reset hashtag count for user
+		users[i].cfriend_nums = NULL; // filled in by stage 4
 
 		/* allocate memory for hashtags array of ith user */ 
 		users[i].hashtags = malloc(MAX_HASHTAG * sizeof(char*)); 
@@ -299,34 +366,81 @@ most_hash_user(user_t *users, int *user_count, int *max_hashtag_user_idx) {
 	}
 }
 
-/* create a matrix array of array of integers */
+/* create a matrix array of array of integers. a reader thread parses the
+   rows from the input while this thread computes the strength of
+   connection of each row already read against the rows before it, so
+   reading and computing overlap
+*/
 int**
-create_matrix(int *user_count) {
+create_matrix(user_t *users, int *user_count, double **soc_matrix) {
 	int **matrix = malloc(*user_count * sizeof(int*)); // allocate mem for matrix
 	assert(matrix);
+	row_queue_t queue;
+	pthread_t reader;
+
+	queue.matrix = matrix;
+	queue.user_count = user_count;
+	queue.rows_ready = 0;
+	pthread_mutex_init(&queue.lock, NULL);
+	pthread_cond_init(&queue.row_read, NULL);
+	if (pthread_create(&reader, NULL, read_rows, &queue) != 0) {
+		fprintf(stderr, "could not start the thread reading the matrix\n");
+		exit(EXIT_FAILURE);
+	}
 
-	for(int i = 0; i < *user_count;) {
-		/* allocate memory for each row */ 
-		matrix[i] = malloc(*user_count * sizeof(int));
-		assert(matrix[i]);
-		for(int j = 0; j < *user_count; j++) {
-			scanf("%d", &matrix[i][j]);
+	for(int i = 0; i < *user_count; i++) {
+		/* wait for the reader thread to finish row i */
+		pthread_mutex_lock(&queue.lock);
+		while (queue.rows_ready <= i) {
+			pthread_cond_wait(&queue.row_read, &queue.lock);
 		}
+		pthread_mutex_unlock(&queue.lock);
 
-		i++; // move onto next row
+		if (soc_matrix != NULL) {
+			process_row(users, matrix, i, user_count, soc_matrix);
+		}
 	}
 
+	pthread_join(reader, NULL);
+	pthread_mutex_destroy(&queue.lock);
+	pthread_cond_destroy(&queue.row_read);
 	return matrix;
 	
 }
 
+/* reader thread of create_matrix(), reads the rows of the matrix one by
+   one and marks each of them ready once all its entries are in */
+void
+*read_rows(void *arg) {
+	row_queue_t *queue = arg;
+	int *row;
+
+	for(int i = 0; i < *queue->user_count; i++) {
+		/* allocate memory for each row */ 
+		row = malloc(*queue->user_count * sizeof(int));
+		assert(row);
+		for(int j = 0; j < *queue->user_count; j++) {
+			scanf("%d", &row[j]);
+		}
+
+		pthread_mutex_lock(&queue->lock);
+		queue->matrix[i] = row;
+		queue->rows_ready++; // row i is ready for the computing thread
+		pthread_cond_signal(&queue->row_read);
+		pthread_mutex_unlock(&queue->lock);
+	}
+
+	return NULL;
+}
+
 /* create a matrix of double type entries that signify soc */
 double**
-create_soc_matrix(int **friendship_m, int *user_count){
+create_soc_matrix(int *user_count){
 	double **soc_matrix = malloc(*user_count * sizeof(double*)); // allocate mem for matrix
 	/* allocate mem for rows */
 	for(int i = 0; i < *user_count; i++) {
 		soc_matrix[i] = malloc(*user_count * sizeof(double));
+		soc_matrix[i][i] = 0; // users are not friends with themselves
 	}
 
 	return soc_matrix;
@@ -356,6 +470,108 @@ s_o_c(int u1[], int u2[], int u1_num, int u2_num, int *user_count){
 	return (double)intersection / set_union;
 }
 
+/* compute the strength of connection between a newly read row and every
+   earlier row into soc_matrix
+*/
+void
+process_row(user_t *users, int **friendship_m, int row, int *user_count,
+double **soc_matrix) {
+	for(int j = 0; j < row; j++) {
+		soc_matrix[j][row] = s_o_c(friendship_m[j], friendship_m[row], 
+		users[j].user_num, users[row].user_num, user_count);
+
+		soc_matrix[row][j] = soc_matrix[j][row]; // property of symetrix matrix
+	}
+}
+
+/* upper bound on the strength of connection of two users given their
+   numbers of friends: the soc is a Jaccard similarity, so it can never
+   exceed min(deg)/max(deg)
+*/
+double
+soc_bound(int deg1, int deg2) {
+	int min_deg = deg1 < deg2 ? deg1 : deg2;
+	int max_deg = deg1 < deg2 ? deg2 : deg1;
+
+	if (min_deg == 0) {
+		return 0;
+	}
+	return (double)min_deg / max_deg;
+}
+
+/* count the number of friends of a user (row sum of the matrix) */
+int
+count_degree(int friends[], int *user_count) {
+	int degree = 0;
+	for(int i = 0; i < *user_count; i++) {
+		if (friends[i] == 1) {
+			degree++;
+		}
+	}
+
+	return degree;
+}
+
+/* offer the connection between users i and j to the top-k heaps of both */
+void
+add_pair_top_k(user_t *users, heap_t *heaps, int i, int j, double soc) {
+	neighbour_t to_i, to_j;
+
+	to_i.user_num = users[j].user_num;
+	to_i.soc = soc;
+	to_j.user_num = users[i].user_num;
+	to_j.soc = soc;
+	heap_push(&heaps[i], to_i);
+	heap_push(&heaps[j], to_j);
+}
+
+/* parse the k of the top-k mode, exiting with a usage message unless it
+   is a positive integer; values beyond INT_MAX are clamped as they are
+   cut down to the number of users later anyway
+*/
+int
+parse_top_k(char *arg, char *prog_name) {
+	char *end;
+	long k = strtol(arg, &end, 10);
+
+	if (end == arg || *end != '\0' || k < 1) {
+		fprintf(stderr, "usage: %s [k] < input\n", prog_name);
+		fprintf(stderr, "k must be a positive integer\n");
+		exit(EXIT_FAILURE);
+	}
+	if (k > INT_MAX) {
+		k = INT_MAX;
+	}
+
+	return (int)k;
+}
+
+/* print the k strongest connections of each user, strongest first,
+   ties broken by the smaller user number
+*/
+void
+print_top_k(heap_t *heaps, int *user_count) {
+	neighbour_t *sorted;
+	int size;
+
+	for(int i = 0; i < *user_count; i++) {
+		size = heaps[i].size;
+		sorted = malloc(heaps[i].capacity * sizeof(neighbour_t));
+		assert(sorted);
+		/* popping yields the weakest first, so fill from the back */
+		for(int j = size - 1; j >= 0; j--) {
+			sorted[j] = heap_pop(&heaps[i]);
+		}
+
+		printf("u%d:", i);
+		for(int j = 0; j < size; j++) {
+			printf(" u%d (%4.2lf)", sorted[j].user_num, sorted[j].soc);
+		}
+		printf("\n");
+		free(sorted);
+	}
+}
+
 /* print out double matrix */
 void
 print_double_matrix(double **soc_matrix, int *user_count){
@@ -382,48 +598,96 @@ is_core(user_t user, int *thc) {
 	}
 }
 
-/* update the close friend count of each user */
+/* find the close friends of each user, and in the top-k mode each user's
+   strongest connections, in one pass over the user pairs. without a
+   soc_matrix (top-k mode) each strength is computed once from
+   friendship_m, skipping the pairs whose soc_bound() can neither beat
+   ths nor enter the heap of either user
+*/
 void
-count_close_friends(user_t *users, double **soc_matrix, int *user_count, 
-double *ths) {
-	/* indexing columns */
+find_connections(user_t *users, int **friendship_m, double **soc_matrix,
+heap_t *heaps, double *ths, int *user_count) {
+	int *degrees = NULL;
+	double soc, bound;
+
+	if (soc_matrix == NULL) {
+		degrees = malloc(*user_count * sizeof(int));
+		assert(degrees);
+		for(int i = 0; i < *user_count; i++) {
+			degrees[i] = count_degree(friendship_m[i], user_count);
+		}
+	}
+
 	for(int i = 0; i < *user_count; i++) {
-		users[i].cfriend_count = 0;		
-		/* indexing rows */
-		for(int j = 0; j < *user_count; j++) {
-			if (soc_matrix[i][j] > *ths) {
-				users[i].cfriend_count++;
+		users[i].cfriend_count = 0;
+		users[i].cfriend_capacity = 0;
+		free(users[i].cfriend_nums);
+		users[i].cfriend_nums = NULL;
+	}
+
+	/* pairs are visited with i <= j in row order, so every user's close
+	   friends are added in ascending order */
+	for(int i = 0; i < *user_count; i++) {
+		for(int j = i; j < *user_count; j++) {
+			if (i == j) {
+				soc = 0; // users are not friends with themselves
+			} else if (soc_matrix != NULL) {
+				soc = soc_matrix[i][j];
+			} else {
+				bound = soc_bound(degrees[i], degrees[j]);
+				if (bound <= *ths && (bound == 0 || 
+				(!can_enter_heap(&heaps[i], bound) && 
+				!can_enter_heap(&heaps[j], bound)))) {
+					continue;
+				}
+
+				soc = s_o_c(friendship_m[i], friendship_m[j], 
+				users[i].user_num, users[j].user_num, user_count);
+				if (soc > 0) {
+					add_pair_top_k(users, heaps, i, j, soc);
+				}
+			}
+
+			if (soc > *ths) {
+				add_close_friend(&users[i], j, user_count);
+				if (i != j) {
+					add_close_friend(&users[j], i, user_count);
+				}
 			}
 		}
 	}
+
+	free(degrees);
 }
 
-/* fill in keys related to close_friends property */
+/* append a close friend to a user, growing the array when it is full */
 void
-fill_close_friends(community_t *communities, user_t *users, int *core_users_count,
-double **soc_matrix, double *ths, int *user_count) {
-
-	/* fill in the close_friend_count */
-	for(int i = 0; i < *core_users_count; i++) {
-		for(int j = 0; j < *user_count; j++) {
-			if (soc_matrix[communities[i].core_user_num][j] > *ths) {
-				communities[i].close_friend_count++;
-			}
+add_close_friend(user_t *user, int friend_num, int *user_count) {
+	if (user->cfriend_count == user->cfriend_capacity) {
+		user->cfriend_capacity = user->cfriend_capacity == 0 ? 
+		1 : 2 * user->cfriend_capacity;
+		if (user->cfriend_capacity > *user_count) {
+			user->cfriend_capacity = *user_count;
 		}
+		user->cfriend_nums = realloc(user->cfriend_nums, 
+		user->cfriend_capacity * sizeof(int));
+		assert(user->cfriend_nums);
 	}
+	user->cfriend_nums[user->cfriend_count++] = friend_num;
+}
+
+/* fill in keys related to close_friends property */
+void
+fill_close_friends(community_t *communities, user_t *users, int *core_users_count) {
+	user_t *core;
 
-	/* obtain the close friend for each core user */
 	for(int i = 0; i < *core_users_count; i++){
-		communities[i].close_friend_nums = 
-		malloc(users[communities[i].core_user_num].cfriend_count
-		* sizeof(int));
+		core = &users[communities[i].core_user_num];
+		communities[i].close_friend_count = core->cfriend_count;
+		communities[i].close_friend_nums = malloc(core->cfriend_count * sizeof(int));
 		assert(communities[i].close_friend_nums);
-		for(int j = 0, k = 0; j < *user_count && 
-		k < users[communities[i].core_user_num].cfriend_count; j++) {
-			if (soc_matrix[communities[i].core_user_num][j] > *ths) {
-				communities[i].close_friend_nums[k] = j;
-				k++;
-			}
+		for(int j = 0; j < core->cfriend_count; j++) {
+			communities[i].close_friend_nums[j] = core->cfriend_nums[j];
 		}
 	}
 }
@@ -503,6 +767,7 @@ free_users(user_t *users, int *user_count) {
 			free(users[i].hashtags[j]); // free memory for each hashtag
 		}
 		free(users[i].hashtags); // free memory for array of hashtags
+		free(users[i].cfriend_nums); // free memory for close friends
 	}
 	free(users); // free the whole user structs
 }
@@ -516,6 +781,15 @@ free_communities(community_t *communities, int *core_users_count){
 	free(communities);
 }
 
+/* free the array of top-k heaps */
+void
+free_heaps(heap_t *heaps, int *user_count) {
+	for(int i = 0; i < *user_count; i++) {
+		free(heaps[i].items);
+	}
+	free(heaps);
+}
+
 /* below are functions skeletons provided by instructor, adapted by me when desired */
 
 /* print stage header given stage number */
@@ -634,6 +908,107 @@ print_list(list_t *list) {
 
 }
 
+/****************************************************************/
+/* bounded min-heap used by the top-k mode of stage 3, ordered so that
+   the root is the weakest connection kept (lowest soc, and on equal soc
+   the larger user number)
+*/
+
+/* create one empty heap of capacity top_k for every user */
+heap_t
+*make_heaps(int *user_count, int *top_k) {
+	heap_t *heaps = malloc(*user_count * sizeof(heap_t));
+	assert(heaps);
+	for(int i = 0; i < *user_count; i++) {
+		heaps[i].items = malloc(*top_k * sizeof(neighbour_t));
+		assert(heaps[i].items);
+		heaps[i].size = 0;
+		heaps[i].capacity = *top_k;
+	}
+
+	return heaps;
+}
+
+/* check if connection a ranks below connection b */
+int
+is_weaker(neighbour_t a, neighbour_t b) {
+	if (a.soc != b.soc) {
+		return a.soc < b.soc;
+	}
+	return a.user_num > b.user_num;
+}
+
+/* check if a connection of strength soc could still be kept in the heap */
+int
+can_enter_heap(heap_t *heap, double soc) {
+	return heap->size < heap->capacity || soc >= heap->items[0].soc;
+}
+
+/* insert a connection, evicting the weakest one once the heap is full */
+void
+heap_push(heap_t *heap, neighbour_t value) {
+	int curr, parent;
+	neighbour_t temp;
+
+	if (heap->size < heap->capacity) {
+		/* sift the new value up from the bottom */
+		curr = heap->size++;
+		heap->items[curr] = value;
+		while (curr > 0) {
+			parent = (curr - 1) / 2;
+			if (!is_weaker(heap->items[curr], heap->items[parent])) {
+				break;
+			}
+			temp = heap->items[curr];
+			heap->items[curr] = heap->items[parent];
+			heap->items[parent] = temp;
+			curr = parent;
+		}
+		return;
+	}
+
+	if (!is_weaker(heap->items[0], value)) {
+		return; // not stronger than the weakest kept connection
+	}
+
+	/* replace the root and sift it down */
+	heap->items[0] = value;
+	heap_sift_down(heap);
+}
+
+/* move the root down until neither child is weaker than it */
+void
+heap_sift_down(heap_t *heap) {
+	int curr = 0, child;
+	neighbour_t temp;
+
+	while ((child = 2 * curr + 1) < heap->size) {
+		if (child + 1 < heap->size && 
+		is_weaker(heap->items[child + 1], heap->items[child])) {
+			child++;
+		}
+		if (!is_weaker(heap->items[child], heap->items[curr])) {
+			break;
+		}
+		temp = heap->items[curr];
+		heap->items[curr] = heap->items[child];
+		heap->items[child] = temp;
+		curr = child;
+	}
+}
+
+/* remove and return the weakest connection in a non-empty heap */
+neighbour_t
+heap_pop(heap_t *heap) {
+	assert(heap->size > 0);
+	neighbour_t weakest = heap->items[0];
+
+	heap->items[0] = heap->items[--heap->size];
+	heap_sift_down(heap);
+
+	return weakest;
+}
+
 /****************************************************************/
 /*
 	Write your time complexity analysis below for Stage 4.2, 
@@ -654,12 +1029,9 @@ print_list(list_t *list) {
 	this part has time complexity of O(U + C)
 
 	The fill_close_friend function has time complexity O(C * U). The reason is that
-	for every core user, the program looks through the respective row in the soc_matrix
-	to find all the close friends of the user, where the number of entries of each row of
-	soc_matrix is U. Hence, there are U number of O(1) operations executed C time, and the overall
-	time complexity is O(C * U). Technically it is O(2 * C * U) since this instance of nested loop
-	is executed twice in this function, but the scalar 2 becomes less important as input size grow
-	so it can be omitted.
+	for every core user, the program copies the close friends already found for that user
+	by find_connections, and a user has at most U - 1 close friends. Hence, there are up to
+	U number of O(1) operations executed C time, and the overall time complexity is O(C * U).
 
 	The fill_unique_hashtag function has time complexity O(U * C * H^2 *T). The reason is that 
 	the function in the worst case would loop though all U users for every core users, in other words